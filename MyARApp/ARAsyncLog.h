@@ -0,0 +1,61 @@
+//
+//  ARAsyncLog.h
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ARAsyncLog_h
+#define ARAsyncLog_h
+
+#include <AR6/ARUtil/log.h>
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Asynchronous backend for arLog().
+ * Once started, every arLog() message is copied, with its timestamp and thread id, into a
+ * fixed-size record of a bounded lock-free multi-producer ring, and a background thread
+ * writes the records out. Calling threads never wait on the output; only the first message
+ * after the writer went idle briefly takes a mutex to wake it. When the ring is full, messages
+ * are dropped and counted.
+ */
+
+/// Longest message kept; longer messages are truncated.
+#define AR_ASYNC_LOG_MESSAGE_MAX 240
+
+/**
+ * Diverts arLog() output to the background writer.
+ * @param path      File to append to, or NULL to write to stderr.
+ * @param forward   Callback to also deliver each message to on the writer thread, or NULL.
+ * @param capacity  Number of records in the ring; rounded up to a power of two.
+ * @return false if already started or the file could not be opened.
+ */
+bool ARAsyncLogStart(const char *path, AR_LOG_LOGGER_CALLBACK forward, int capacity = 1024);
+
+/** Writes out queued messages, then restores arLog()'s default output. */
+void ARAsyncLogStop(void);
+
+/** Number of messages lost because the ring was full. */
+uint64_t ARAsyncLogDroppedCount(void);
+
+/**
+ * Returns true at most once per interval for a given call site.
+ * @param last      Per-call-site time of the last emission, in microseconds.
+ * @param interval  Minimum time between emissions, in seconds.
+ */
+bool ARAsyncLogShouldEmit(std::atomic<uint64_t> *last, double interval);
+
+/// arLog() limited to one message per interval (seconds) from this call site.
+#define ARLOG_LIMITED(interval, level, ...) \
+  do { \
+    static std::atomic<uint64_t> arLogLimitedLast(0); \
+    if (level >= arLogLevel && ARAsyncLogShouldEmit(&arLogLimitedLast, interval)) arLog(NULL, level, __VA_ARGS__); \
+  } while (0)
+#define ARLOGi_LIMITED(interval, ...) ARLOG_LIMITED(interval, AR_LOG_LEVEL_INFO, __VA_ARGS__)
+#define ARLOGw_LIMITED(interval, ...) ARLOG_LIMITED(interval, AR_LOG_LEVEL_WARN, __VA_ARGS__)
+#define ARLOGe_LIMITED(interval, ...) ARLOG_LIMITED(interval, AR_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#endif /* ARAsyncLog_h */
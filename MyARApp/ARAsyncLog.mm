@@ -0,0 +1,200 @@
+//
+//  ARAsyncLog.mm
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ARAsyncLog.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Record {
+  std::atomic<uint64_t> sequence;       ///< Slot state, as in a bounded MPMC queue (D. Vyukov).
+  uint64_t timeUs;
+  uint64_t threadId;
+  uint32_t length;
+  char text[AR_ASYNC_LOG_MESSAGE_MAX];
+};
+
+std::vector<Record> gRing;
+uint64_t gMask;
+std::atomic<uint64_t> gEnqueuePos;
+uint64_t gDequeuePos;                   // Only the writer thread dequeues.
+std::atomic<uint64_t> gDropped;
+std::atomic<bool> gRunning(false);
+std::atomic<bool> gAccepting(false);    // Producers may use gRing.
+std::atomic<int> gProducers(0);         // Producers inside enqueue().
+std::thread gWriter;
+std::mutex gWakeMutex;
+std::condition_variable gWake;
+std::atomic<bool> gWriterSleeping(false); // The writer found the ring empty and waits on gWake.
+FILE *gFile;
+AR_LOG_LOGGER_CALLBACK gForward;
+
+inline uint64_t nowUs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void enqueueAccepted(const char *logMessage) {
+  uint64_t pos = gEnqueuePos.load(std::memory_order_relaxed);
+  Record *r;
+  while (true) {
+    r = &gRing[pos & gMask];
+    const uint64_t seq = r->sequence.load(std::memory_order_acquire);
+    const int64_t diff = (int64_t)seq - (int64_t)pos;
+    if (diff == 0) {
+      if (gEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      gDropped++;
+      return;
+    } else {
+      pos = gEnqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+  r->timeUs = nowUs();
+  r->threadId = (uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+  size_t len = strlen(logMessage);
+  if (len > AR_ASYNC_LOG_MESSAGE_MAX) {
+    // Keep the line break, so the next message starts on its own line.
+    const bool newline = (logMessage[len - 1] == '\n');
+    len = AR_ASYNC_LOG_MESSAGE_MAX;
+    memcpy(r->text, logMessage, len);
+    if (newline) r->text[len - 1] = '\n';
+  } else {
+    memcpy(r->text, logMessage, len);
+  }
+  r->length = (uint32_t)len;
+  r->sequence.store(pos + 1, std::memory_order_release);
+
+  // Only the first message after the writer went idle takes the mutex.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (gWriterSleeping.load(std::memory_order_relaxed) && gWriterSleeping.exchange(false)) {
+    std::lock_guard<std::mutex> lock(gWakeMutex);
+    gWake.notify_one();
+  }
+}
+
+// arLog() may already have fetched this callback when ARAsyncLogStop() removes it, so producers
+// register themselves, and stop waits for them before the ring can be replaced by a later start.
+void ARUTIL_CALLBACK enqueue(const char *logMessage) {
+  gProducers++;
+  if (gAccepting) enqueueAccepted(logMessage);
+  gProducers--;
+}
+
+inline bool ringHasRecord() {
+  return (gRing[gDequeuePos & gMask].sequence.load(std::memory_order_acquire) == gDequeuePos + 1);
+}
+
+// Writes out one record if available. Returns false if the ring is empty.
+bool dequeueOne() {
+  Record &r = gRing[gDequeuePos & gMask];
+  if (r.sequence.load(std::memory_order_acquire) != gDequeuePos + 1) return false;
+
+  char line[AR_ASYNC_LOG_MESSAGE_MAX + 1];
+  memcpy(line, r.text, r.length);
+  line[r.length] = '\0';
+  const uint64_t timeUs = r.timeUs, threadId = r.threadId;
+  r.sequence.store(gDequeuePos + gMask + 1, std::memory_order_release);
+  gDequeuePos++;
+
+  FILE *fp = (gFile ? gFile : stderr);
+  fprintf(fp, "[%llu.%06llu %04llx] %s", (unsigned long long)(timeUs / 1000000), (unsigned long long)(timeUs % 1000000),
+          (unsigned long long)(threadId & 0xffff), line);
+  if (gForward) gForward(line);
+  return true;
+}
+
+void writerLoop() {
+  while (true) {
+    if (dequeueOne()) continue;
+    if (!gRunning) break;
+    fflush(gFile ? gFile : stderr);
+    // Block until a producer publishes into the empty ring, or stop. The flag is raised before
+    // the ring is checked again, so a producer that published in between either is seen here or
+    // sees the flag and wakes the writer.
+    std::unique_lock<std::mutex> lock(gWakeMutex);
+    gWriterSleeping = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ringHasRecord() || !gRunning) {
+      gWriterSleeping = false;
+      continue;
+    }
+    gWake.wait(lock, [] { return !gWriterSleeping; });
+  }
+  fflush(gFile ? gFile : stderr);
+}
+
+} // namespace
+
+bool ARAsyncLogStart(const char *path, AR_LOG_LOGGER_CALLBACK forward, int capacity) {
+  if (gRunning) return false;
+  gFile = NULL;
+  if (path) {
+    gFile = fopen(path, "a");
+    if (!gFile) {
+      ARLOGe("Error opening log file '%s'.\n", path);
+      return false;
+    }
+  }
+  gForward = forward;
+
+  uint64_t size = 2;
+  while (size < (uint64_t)capacity) size <<= 1;
+  std::vector<Record> ring(size);
+  gRing.swap(ring);
+  gMask = size - 1;
+  for (uint64_t i = 0; i < size; i++) gRing[i].sequence.store(i, std::memory_order_relaxed);
+  gEnqueuePos = 0;
+  gDequeuePos = 0;
+  gDropped = 0;
+
+  gRunning = true;
+  gWriter = std::thread(writerLoop);
+  gAccepting = true;
+  arLogSetLogger(enqueue, 0);
+  return true;
+}
+
+void ARAsyncLogStop(void) {
+  if (!gRunning) return;
+  arLogSetLogger(NULL, 0);
+  gAccepting = false;
+  while (gProducers > 0) std::this_thread::yield();
+  {
+    std::lock_guard<std::mutex> lock(gWakeMutex);
+    gRunning = false;
+    gWriterSleeping = false;
+  }
+  gWake.notify_one();
+  gWriter.join();
+  if (gFile) {
+    fclose(gFile);
+    gFile = NULL;
+  }
+  if (gDropped > 0) {
+    ARLOGw("%llu log messages were dropped.\n", (unsigned long long)gDropped.load());
+  }
+}
+
+uint64_t ARAsyncLogDroppedCount(void) {
+  return gDropped;
+}
+
+bool ARAsyncLogShouldEmit(std::atomic<uint64_t> *last, double interval) {
+  const uint64_t now = nowUs();
+  uint64_t prev = last->load(std::memory_order_relaxed);
+  if (prev != 0 && now - prev < (uint64_t)(interval * 1e6)) return false;
+  return last->compare_exchange_strong(prev, now, std::memory_order_relaxed);
+}
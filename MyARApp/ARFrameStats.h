@@ -0,0 +1,68 @@
+//
+//  ARFrameStats.h
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ARFrameStats_h
+#define ARFrameStats_h
+
+#include <AR6/AR/ar.h>
+
+#include <mutex>
+#include <vector>
+
+/**
+ * What one tracked frame cost and what it found.
+ */
+struct ARFrameStatsRecord {
+  uint64_t frameIndex;
+  AR2VideoTimestampT frameTime;         ///< Capture time of the frame, on the monotonic clock.
+  float captureMs;                      ///< ARController::capture().
+  float updateMs;                       ///< ARController::update(), all trackers.
+  float filterMs;                       ///< Pose filtering and history.
+  int trackableCount;
+  int visibleCount;
+  int acquiredCount;                    ///< Trackables that became visible on this frame.
+  int lostCount;                        ///< Trackables that stopped being visible on this frame.
+  int visibleFeatureCount;              ///< Reference features of the visible 2D trackables.
+  int maxSimultaneousTrackedImages;     ///< Limit in use by the 2D tracker.
+};
+
+/**
+ * Keeps the most recent per-frame statistics records in a fixed ring buffer.
+ * Records are added on the tracking thread and may be read from any thread.
+ */
+class ARFrameStats {
+
+private:
+  std::vector<ARFrameStatsRecord> m_records;
+  uint64_t m_count;                     ///< Total records ever added.
+  mutable std::mutex m_lock;
+
+public:
+  /**
+   * @param capacity  Number of records kept.
+   */
+  explicit ARFrameStats(int capacity = 300);
+
+  void add(const ARFrameStatsRecord &record);
+
+  void clear();
+
+  /**
+   * Copies the most recent record.
+   * @return false if no record has been added yet.
+   */
+  bool latest(ARFrameStatsRecord *record) const;
+
+  /**
+   * Copies up to maxCount of the most recent records, oldest first.
+   * @return The number of records copied.
+   */
+  int recent(ARFrameStatsRecord *records, int maxCount) const;
+};
+
+#endif /* ARFrameStats_h */
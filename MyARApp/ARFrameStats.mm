@@ -0,0 +1,43 @@
+//
+//  ARFrameStats.mm
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ARFrameStats.h"
+
+ARFrameStats::ARFrameStats(int capacity) :
+  m_records(capacity < 1 ? 1 : capacity),
+  m_count(0) {
+}
+
+void ARFrameStats::add(const ARFrameStatsRecord &record) {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_records[m_count % m_records.size()] = record;
+  m_count++;
+}
+
+void ARFrameStats::clear() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_count = 0;
+}
+
+bool ARFrameStats::latest(ARFrameStatsRecord *record) const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if (m_count == 0 || !record) return false;
+  *record = m_records[(m_count - 1) % m_records.size()];
+  return true;
+}
+
+int ARFrameStats::recent(ARFrameStatsRecord *records, int maxCount) const {
+  std::lock_guard<std::mutex> lock(m_lock);
+  if (!records || maxCount <= 0) return 0;
+  uint64_t n = (m_count < m_records.size() ? m_count : m_records.size());
+  if (n > (uint64_t)maxCount) n = maxCount;
+  for (uint64_t i = 0; i < n; i++) {
+    records[i] = m_records[(m_count - n + i) % m_records.size()];
+  }
+  return (int)n;
+}
@@ -0,0 +1,102 @@
+//
+//  ARLatencyStats.h
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ARLatencyStats_h
+#define ARLatencyStats_h
+
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * Rolling latency measurements from frame arrival to the later stages of the pipeline,
+ * kept per video source over a window of the most recent frames.
+ * ARController does not expose the frame buffer timestamp, so arrival is only known to lie
+ * between two polls: the previous capture() call, when the frame was not yet available, and
+ * the capture() call that returned it. Each probe therefore records a lower bound, measured from
+ * the returning poll, and an upper bound, measured from the previous one. The real latency lies
+ * between them; they differ by the polling interval.
+ * Samples are added on the rendering thread and may be queried from any thread.
+ */
+class ARLatencyStats {
+
+public:
+  /// Pipeline stages measured from the arrival of a frame.
+  enum Probe {
+    TrackerStart,                       ///< ARController::update() begins. The lower bound is the
+                                        ///< capture() time, the upper bound adds the polling interval.
+    TrackerEnd,                         ///< ARController::update() returns.
+    PosePublish,                        ///< Filtered poses are available to the renderer.
+    Display,                            ///< First render using the frame, plus one display refresh period:
+                                        ///< an estimate, as presentation time is not reported.
+    ProbeCount
+  };
+
+  /// Which end of the arrival interval a latency is measured from.
+  enum Bound {
+    Lower,                              ///< Measured from the poll that returned the frame.
+    Upper,                              ///< Measured from the poll before it.
+    BoundCount
+  };
+
+  struct Summary {
+    int count;
+    float meanMs;
+    float p50Ms;
+    float p90Ms;
+    float p99Ms;
+    float maxMs;
+  };
+
+  static constexpr float HistogramBucketMs = 1.0f;
+  static constexpr int HistogramBucketCount = 200; ///< The last bucket also counts longer latencies.
+
+private:
+  struct Series {
+    std::vector<float> samples;         ///< Ring of the most recent latencies, in milliseconds.
+    uint64_t count = 0;                 ///< Total samples ever added.
+    std::vector<int> buckets;           ///< Histogram of the samples in the ring.
+  };
+  struct Source {
+    Series series[ProbeCount][BoundCount];
+  };
+
+  int m_window;
+  std::map<int, Source> m_sources;
+  mutable std::mutex m_lock;
+
+  static int bucketOf(float latencyMs);
+
+public:
+  /**
+   * @param window  Number of most recent samples kept for each source and probe.
+   */
+  explicit ARLatencyStats(int window = 300);
+
+  /** Records one frame's latency at a probe, as the lower and upper bounds. */
+  void add(int videoSourceIndex, Probe probe, float lowerMs, float upperMs);
+
+  void clear();
+
+  /**
+   * Summarises the samples in the window.
+   * @return false if there are no samples for this source and probe.
+   */
+  bool summary(int videoSourceIndex, Probe probe, Bound bound, Summary *summary) const;
+
+  /**
+   * Copies the histogram of the samples in the window; bucket i counts latencies in
+   * [i, i + 1) * HistogramBucketMs.
+   * @param counts  Array of HistogramBucketCount elements.
+   * @return false if there are no samples for this source and probe.
+   */
+  bool histogram(int videoSourceIndex, Probe probe, Bound bound, int *counts) const;
+};
+
+#endif /* ARLatencyStats_h */
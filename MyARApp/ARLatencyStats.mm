@@ -0,0 +1,82 @@
+//
+//  ARLatencyStats.mm
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ARLatencyStats.h"
+
+#include <algorithm>
+#include <string.h>
+
+constexpr float ARLatencyStats::HistogramBucketMs;
+constexpr int ARLatencyStats::HistogramBucketCount;
+
+ARLatencyStats::ARLatencyStats(int window) :
+  m_window(window < 1 ? 1 : window) {
+}
+
+int ARLatencyStats::bucketOf(float latencyMs) {
+  int bucket = (int)(latencyMs / HistogramBucketMs);
+  return std::min(std::max(bucket, 0), HistogramBucketCount - 1);
+}
+
+void ARLatencyStats::add(int videoSourceIndex, Probe probe, float lowerMs, float upperMs) {
+  if (probe < 0 || probe >= ProbeCount) return;
+  std::lock_guard<std::mutex> lock(m_lock);
+  const float latencies[BoundCount] = {lowerMs, upperMs};
+  for (int bound = 0; bound < BoundCount; bound++) {
+    Series &s = m_sources[videoSourceIndex].series[probe][bound];
+    if (s.samples.empty()) {
+      s.samples.resize(m_window);
+      s.buckets.assign(HistogramBucketCount, 0);
+    }
+    float &slot = s.samples[s.count % m_window];
+    if (s.count >= (uint64_t)m_window) s.buckets[bucketOf(slot)]--;
+    slot = latencies[bound];
+    s.buckets[bucketOf(latencies[bound])]++;
+    s.count++;
+  }
+}
+
+void ARLatencyStats::clear() {
+  std::lock_guard<std::mutex> lock(m_lock);
+  m_sources.clear();
+}
+
+bool ARLatencyStats::summary(int videoSourceIndex, Probe probe, Bound bound, Summary *summary) const {
+  if (probe < 0 || probe >= ProbeCount || bound < 0 || bound >= BoundCount || !summary) return false;
+  std::vector<float> sorted;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_sources.find(videoSourceIndex);
+    if (it == m_sources.end()) return false;
+    const Series &s = it->second.series[probe][bound];
+    if (s.count == 0) return false;
+    sorted.assign(s.samples.begin(), s.samples.begin() + std::min(s.count, (uint64_t)m_window));
+  }
+  std::sort(sorted.begin(), sorted.end());
+  const size_t n = sorted.size();
+  double total = 0.0;
+  for (float v : sorted) total += v;
+  summary->count = (int)n;
+  summary->meanMs = (float)(total / n);
+  summary->p50Ms = sorted[(n - 1) * 50 / 100];
+  summary->p90Ms = sorted[(n - 1) * 90 / 100];
+  summary->p99Ms = sorted[(n - 1) * 99 / 100];
+  summary->maxMs = sorted[n - 1];
+  return true;
+}
+
+bool ARLatencyStats::histogram(int videoSourceIndex, Probe probe, Bound bound, int *counts) const {
+  if (probe < 0 || probe >= ProbeCount || bound < 0 || bound >= BoundCount || !counts) return false;
+  std::lock_guard<std::mutex> lock(m_lock);
+  auto it = m_sources.find(videoSourceIndex);
+  if (it == m_sources.end()) return false;
+  const Series &s = it->second.series[probe][bound];
+  if (s.count == 0) return false;
+  memcpy(counts, s.buckets.data(), HistogramBucketCount * sizeof(int));
+  return true;
+}
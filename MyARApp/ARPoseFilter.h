@@ -0,0 +1,153 @@
+//
+//  ARPoseFilter.h
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ARPoseFilter_h
+#define ARPoseFilter_h
+
+#include <AR6/ARTrackable.h>
+
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Filters the poses of many trackables in a single pass.
+ * The state of every registered trackable is kept in contiguous structure-of-arrays
+ * buffers so that the position and quaternion update vectorizes across trackables,
+ * instead of calling arFilterTransMat() once per trackable per frame.
+ * Registering a trackable disables its own ARFilterTransMatInfo filter. A trackable
+ * must be removed from the batch before it is removed from the ARController.
+ */
+class ARPoseFilterBatch {
+
+public:
+  enum FilterType {
+    LowPass,                            ///< Fixed first-order low-pass, same response as arFilterTransMat().
+    OneEuro,                            ///< One Euro filter: low-pass whose cutoff rises with speed.
+    Kalman                              ///< Constant-velocity Kalman filter.
+  };
+
+  struct OneEuroParameters {
+    ARdouble minCutoff;                 ///< Cutoff frequency (Hz) at rest.
+    ARdouble betaPosition;              ///< Cutoff increase (Hz) per mm/s of translational speed.
+    ARdouble betaRotation;              ///< Cutoff increase (Hz) per rad/s of angular speed.
+    ARdouble derivativeCutoff;          ///< Cutoff frequency (Hz) of the speed estimate.
+  };
+
+  /**
+   * Smoothing depends on the ratio of process to measurement noise. The defaults assume a
+   * pose noise of 1 mm and about 0.1 degree (quaternion component variance 1e-6), with a ratio
+   * of 1000 s^-3. At 30 Hz this leaves about 60% of the measurement jitter (the LowPass default
+   * leaves about 80%). Constant velocity is tracked without lag, but a change of velocity lags
+   * briefly: a motion starting at 200 mm/s trails by up to 5 mm. Lower the ratio for less jitter
+   * and more lag.
+   */
+  struct KalmanParameters {
+    ARdouble processNoisePosition;      ///< Acceleration noise density, mm^2/s^3.
+    ARdouble processNoiseRotation;      ///< Acceleration noise density of quaternion components, 1/s^3.
+    ARdouble measurementNoisePosition;  ///< Pose estimate variance, mm^2.
+    ARdouble measurementNoiseRotation;  ///< Pose estimate variance of quaternion components.
+  };
+
+private:
+  struct Entry {
+    ARTrackable *trackable;
+    FilterType type;
+    int lane;                           ///< Index into the lanes of m_banks[type].
+    bool needsReset;                    ///< Set when the entry moves to a fresh lane.
+    ARdouble sampleRate;
+    ARdouble cutoffFrequency;
+    OneEuroParameters oneEuro;
+    KalmanParameters kalman;
+  };
+
+  // Structure-of-arrays state for all entries of one filter type, one lane per entry.
+  struct Bank {
+    std::vector<int> entry;             ///< Index into m_entries of each lane.
+    // Filtered pose.
+    std::vector<float> px, py, pz;
+    std::vector<float> qw, qx, qy, qz;
+    // Per-frame input samples.
+    std::vector<float> inPx, inPy, inPz;
+    std::vector<float> inQw, inQx, inQy, inQz;
+    std::vector<float> reset;           ///< 1.0f where the filter memory must be set to the sample.
+    // LowPass.
+    std::vector<float> alpha;
+    // OneEuro.
+    std::vector<float> minCutoff, betaPosition, betaRotation, derivativeCutoff;
+    std::vector<float> dpx, dpy, dpz, dRotation;
+    // Kalman. Covariances are shared by the components of position and of rotation.
+    std::vector<float> noisePosition, noiseRotation, varPosition, varRotation;
+    std::vector<float> vpx, vpy, vpz;
+    std::vector<float> vqw, vqx, vqy, vqz;
+    std::vector<float> pP00, pP01, pP11;
+    std::vector<float> rP00, rP01, rP11;
+
+    std::vector<std::vector<float> *> lanes();
+    int add(int entryIndex);
+    void remove(int lane);
+  };
+
+  std::vector<Entry> m_entries;
+  std::unordered_map<int, int> m_indexByUID;
+  Bank m_banks[3];
+  std::vector<ARdouble> m_output;       ///< 16 ARdoubles per entry, OpenGL layout.
+  AR2VideoTimestampT m_lastUpdateTime;
+
+  int indexOf(int UID) const;
+  void writeParameters(int index);
+  void addToBank(int index);
+  void removeFromBank(int index);
+  void filterLowPass(Bank &bank);
+  void filterOneEuro(Bank &bank, float dt);
+  void filterKalman(Bank &bank, float dt);
+
+public:
+  ARPoseFilterBatch();
+
+  /**
+   * Adds the trackable to, or removes it from, the batch.
+   * @param trackable  The trackable, as returned by ARController::findTrackable().
+   * @param flag       true to filter the trackable's pose in the batch.
+   */
+  void setFiltered(ARTrackable *trackable, bool flag);
+  bool isFiltered(int UID) const;
+
+  FilterType filterType(int UID) const;
+  void setFilterType(int UID, FilterType type);
+
+  // LowPass parameters.
+  ARdouble filterSampleRate(int UID) const;
+  void setFilterSampleRate(int UID, ARdouble rate);
+  ARdouble filterCutoffFrequency(int UID) const;
+  void setFilterCutoffFrequency(int UID, ARdouble freq);
+
+  OneEuroParameters oneEuroParameters(int UID) const;
+  void setOneEuroParameters(int UID, const OneEuroParameters &params);
+
+  KalmanParameters kalmanParameters(int UID) const;
+  void setKalmanParameters(int UID, const KalmanParameters &params);
+
+  /** Removes all trackables from the batch. */
+  void clear();
+
+  /**
+   * Filters the current pose of every registered trackable.
+   * Call once per frame, after ARController::update().
+   * @param frameTime  Capture time of the frame the poses were estimated from. The OneEuro
+   *     and Kalman filters step by the real interval between successive frame times.
+   */
+  void update(const AR2VideoTimestampT &frameTime);
+
+  /**
+   * Copies the filtered pose of the trackable with the given UID.
+   * @return false if the trackable is not registered or not visible.
+   */
+  bool getTransformationMatrix(int UID, ARdouble mat[16]) const;
+};
+
+#endif /* ARPoseFilter_h */
@@ -0,0 +1,424 @@
+//
+//  ARPoseFilter.mm
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ARPoseFilter.h"
+#import "ARToolkitExtensions.h"
+
+#include <math.h>
+#include <algorithm>
+
+// MARK: - Matrix conversions
+
+static void quatPosFromMatrix(const ARdouble m[16], float q[4], float p[3]) {
+  ARdouble dq[4], dp[3];
+  ARQuatPosFromMatrix(m, dq, dp);
+  for (int i = 0; i < 4; i++) q[i] = (float)dq[i];
+  for (int i = 0; i < 3; i++) p[i] = (float)dp[i];
+}
+
+static void matrixFromQuatPos(const float q[4], const float p[3], ARdouble m[16]) {
+  const ARdouble dq[4] = {q[0], q[1], q[2], q[3]};
+  const ARdouble dp[3] = {p[0], p[1], p[2]};
+  ARMatrixFromQuatPos(dq, dp, m);
+}
+
+// Smoothing factor of a first-order low-pass with the given cutoff, sampled every dt seconds.
+static inline float lowPassAlpha(float dt, float cutoff) {
+  const float rc = 1.0f / (2.0f * (float)M_PI * cutoff);
+  return dt / (dt + rc);
+}
+
+static const float kDefaultDt = (float)(1.0 / AR_FILTER_TRANS_MAT_SAMPLE_RATE_DEFAULT);
+static const float kMinDt = 1e-4f;
+static const float kMaxDt = 1.0f;
+
+// MARK: - ARPoseFilterBatch::Bank
+
+std::vector<std::vector<float> *> ARPoseFilterBatch::Bank::lanes() {
+  return {&px, &py, &pz, &qw, &qx, &qy, &qz,
+          &inPx, &inPy, &inPz, &inQw, &inQx, &inQy, &inQz, &reset,
+          &alpha,
+          &minCutoff, &betaPosition, &betaRotation, &derivativeCutoff, &dpx, &dpy, &dpz, &dRotation,
+          &noisePosition, &noiseRotation, &varPosition, &varRotation,
+          &vpx, &vpy, &vpz, &vqw, &vqx, &vqy, &vqz, &pP00, &pP01, &pP11, &rP00, &rP01, &rP11};
+}
+
+int ARPoseFilterBatch::Bank::add(int entryIndex) {
+  entry.push_back(entryIndex);
+  for (std::vector<float> *lane : lanes()) {
+    lane->push_back(0.0f);
+  }
+  qw.back() = 1.0f; // Identity, so that the hemisphere test and renormalisation stay finite.
+  return (int)entry.size() - 1;
+}
+
+void ARPoseFilterBatch::Bank::remove(int lane) {
+  // Swap-remove keeps the lanes contiguous.
+  const size_t last = entry.size() - 1;
+  entry[lane] = entry[last];
+  entry.pop_back();
+  for (std::vector<float> *l : lanes()) {
+    (*l)[lane] = (*l)[last];
+    l->pop_back();
+  }
+}
+
+// MARK: - ARPoseFilterBatch
+
+ARPoseFilterBatch::ARPoseFilterBatch() :
+  m_lastUpdateTime({0, 0}) {
+}
+
+int ARPoseFilterBatch::indexOf(int UID) const {
+  auto it = m_indexByUID.find(UID);
+  return (it == m_indexByUID.end() ? -1 : it->second);
+}
+
+void ARPoseFilterBatch::writeParameters(int index) {
+  const Entry &e = m_entries[index];
+  Bank &bank = m_banks[e.type];
+  const int i = e.lane;
+  // Same first-order response as arFilterTransMat(): alpha = dt / (dt + RC).
+  bank.alpha[i] = lowPassAlpha((float)(1.0 / e.sampleRate), (float)e.cutoffFrequency);
+  bank.minCutoff[i] = (float)e.oneEuro.minCutoff;
+  bank.betaPosition[i] = (float)e.oneEuro.betaPosition;
+  bank.betaRotation[i] = (float)e.oneEuro.betaRotation;
+  bank.derivativeCutoff[i] = (float)e.oneEuro.derivativeCutoff;
+  bank.noisePosition[i] = (float)e.kalman.processNoisePosition;
+  bank.noiseRotation[i] = (float)e.kalman.processNoiseRotation;
+  bank.varPosition[i] = (float)e.kalman.measurementNoisePosition;
+  bank.varRotation[i] = (float)e.kalman.measurementNoiseRotation;
+}
+
+void ARPoseFilterBatch::addToBank(int index) {
+  Entry &e = m_entries[index];
+  e.lane = m_banks[e.type].add(index);
+  // A new lane has no history, so its first sample must reset it.
+  e.needsReset = true;
+  writeParameters(index);
+}
+
+void ARPoseFilterBatch::removeFromBank(int index) {
+  const Entry &e = m_entries[index];
+  Bank &bank = m_banks[e.type];
+  bank.remove(e.lane);
+  if (e.lane < (int)bank.entry.size()) m_entries[bank.entry[e.lane]].lane = e.lane;
+}
+
+void ARPoseFilterBatch::setFiltered(ARTrackable *trackable, bool flag) {
+  if (!trackable) return;
+  int index = indexOf(trackable->UID);
+  if (flag) {
+    if (index != -1) return;
+    // The batch replaces the trackable's own filter.
+    trackable->setFiltered(false);
+    Entry e;
+    e.trackable = trackable;
+    e.type = LowPass;
+    e.lane = -1;
+    e.needsReset = true;
+    e.sampleRate = AR_FILTER_TRANS_MAT_SAMPLE_RATE_DEFAULT;
+    e.cutoffFrequency = AR_FILTER_TRANS_MAT_CUTOFF_FREQ_DEFAULT;
+    e.oneEuro = {1.0, 0.05, 5.0, 1.0};
+    e.kalman = {1.0e3, 1.0e-3, 1.0, 1.0e-6};
+    m_entries.push_back(e);
+    index = (int)m_entries.size() - 1;
+    m_indexByUID[trackable->UID] = index;
+    m_output.resize(m_entries.size() * 16, 0.0);
+    addToBank(index);
+  } else {
+    if (index == -1) return;
+    removeFromBank(index);
+    // Swap-remove, then point the moved entry's lane back at its new index.
+    const int last = (int)m_entries.size() - 1;
+    m_indexByUID.erase(trackable->UID);
+    if (index != last) {
+      m_entries[index] = m_entries[last];
+      m_indexByUID[m_entries[index].trackable->UID] = index;
+      m_banks[m_entries[index].type].entry[m_entries[index].lane] = index;
+      std::copy(m_output.begin() + last * 16, m_output.end(), m_output.begin() + index * 16);
+    }
+    m_entries.pop_back();
+    m_output.resize(last * 16);
+  }
+}
+
+bool ARPoseFilterBatch::isFiltered(int UID) const {
+  return indexOf(UID) != -1;
+}
+
+ARPoseFilterBatch::FilterType ARPoseFilterBatch::filterType(int UID) const {
+  int index = indexOf(UID);
+  return (index == -1 ? LowPass : m_entries[index].type);
+}
+
+void ARPoseFilterBatch::setFilterType(int UID, FilterType type) {
+  int index = indexOf(UID);
+  if (index == -1 || m_entries[index].type == type) return;
+  removeFromBank(index);
+  m_entries[index].type = type;
+  addToBank(index);
+}
+
+ARdouble ARPoseFilterBatch::filterSampleRate(int UID) const {
+  int index = indexOf(UID);
+  return (index == -1 ? AR_FILTER_TRANS_MAT_SAMPLE_RATE_DEFAULT : m_entries[index].sampleRate);
+}
+
+void ARPoseFilterBatch::setFilterSampleRate(int UID, ARdouble rate) {
+  int index = indexOf(UID);
+  if (index == -1 || rate <= 0.0) return;
+  m_entries[index].sampleRate = rate;
+  writeParameters(index);
+}
+
+ARdouble ARPoseFilterBatch::filterCutoffFrequency(int UID) const {
+  int index = indexOf(UID);
+  return (index == -1 ? AR_FILTER_TRANS_MAT_CUTOFF_FREQ_DEFAULT : m_entries[index].cutoffFrequency);
+}
+
+void ARPoseFilterBatch::setFilterCutoffFrequency(int UID, ARdouble freq) {
+  int index = indexOf(UID);
+  if (index == -1 || freq <= 0.0) return;
+  m_entries[index].cutoffFrequency = freq;
+  writeParameters(index);
+}
+
+ARPoseFilterBatch::OneEuroParameters ARPoseFilterBatch::oneEuroParameters(int UID) const {
+  int index = indexOf(UID);
+  return (index == -1 ? OneEuroParameters() : m_entries[index].oneEuro);
+}
+
+void ARPoseFilterBatch::setOneEuroParameters(int UID, const OneEuroParameters &params) {
+  int index = indexOf(UID);
+  if (index == -1 || params.minCutoff <= 0.0 || params.derivativeCutoff <= 0.0 ||
+      params.betaPosition < 0.0 || params.betaRotation < 0.0) return;
+  m_entries[index].oneEuro = params;
+  writeParameters(index);
+}
+
+ARPoseFilterBatch::KalmanParameters ARPoseFilterBatch::kalmanParameters(int UID) const {
+  int index = indexOf(UID);
+  return (index == -1 ? KalmanParameters() : m_entries[index].kalman);
+}
+
+void ARPoseFilterBatch::setKalmanParameters(int UID, const KalmanParameters &params) {
+  int index = indexOf(UID);
+  if (index == -1 || params.processNoisePosition <= 0.0 || params.processNoiseRotation <= 0.0 ||
+      params.measurementNoisePosition <= 0.0 || params.measurementNoiseRotation <= 0.0) return;
+  m_entries[index].kalman = params;
+  writeParameters(index);
+}
+
+void ARPoseFilterBatch::clear() {
+  while (!m_entries.empty()) {
+    setFiltered(m_entries.back().trackable, false);
+  }
+  m_lastUpdateTime = {0, 0};
+}
+
+// MARK: - Kernels
+// Each kernel is branch-free so that the compiler maps each iteration to one SIMD lane.
+
+void ARPoseFilterBatch::filterLowPass(Bank &b) {
+  const int count = (int)b.entry.size();
+  float *__restrict px = b.px.data(), *__restrict py = b.py.data(), *__restrict pz = b.pz.data();
+  float *__restrict qw = b.qw.data(), *__restrict qx = b.qx.data(), *__restrict qy = b.qy.data(), *__restrict qz = b.qz.data();
+  const float *__restrict ipx = b.inPx.data(), *__restrict ipy = b.inPy.data(), *__restrict ipz = b.inPz.data();
+  const float *__restrict iqw = b.inQw.data(), *__restrict iqx = b.inQx.data(), *__restrict iqy = b.inQy.data(), *__restrict iqz = b.inQz.data();
+  const float *__restrict alpha = b.alpha.data(), *__restrict reset = b.reset.data();
+
+#pragma clang loop vectorize(enable)
+  for (int i = 0; i < count; i++) {
+    const float a = alpha[i] + reset[i] * (1.0f - alpha[i]); // A reset takes the sample as-is.
+    px[i] += a * (ipx[i] - px[i]);
+    py[i] += a * (ipy[i] - py[i]);
+    pz[i] += a * (ipz[i] - pz[i]);
+    // Interpolate towards whichever of q and -q lies in the same hemisphere, then renormalise.
+    const float d = qw[i] * iqw[i] + qx[i] * iqx[i] + qy[i] * iqy[i] + qz[i] * iqz[i];
+    const float s = (d < 0.0f ? -1.0f : 1.0f);
+    const float w = qw[i] + a * (s * iqw[i] - qw[i]);
+    const float x = qx[i] + a * (s * iqx[i] - qx[i]);
+    const float y = qy[i] + a * (s * iqy[i] - qy[i]);
+    const float z = qz[i] + a * (s * iqz[i] - qz[i]);
+    const float n = 1.0f / sqrtf(w * w + x * x + y * y + z * z);
+    qw[i] = w * n; qx[i] = x * n; qy[i] = y * n; qz[i] = z * n;
+  }
+}
+
+void ARPoseFilterBatch::filterOneEuro(Bank &b, float dt) {
+  const int count = (int)b.entry.size();
+  float *__restrict px = b.px.data(), *__restrict py = b.py.data(), *__restrict pz = b.pz.data();
+  float *__restrict qw = b.qw.data(), *__restrict qx = b.qx.data(), *__restrict qy = b.qy.data(), *__restrict qz = b.qz.data();
+  float *__restrict dpx = b.dpx.data(), *__restrict dpy = b.dpy.data(), *__restrict dpz = b.dpz.data(), *__restrict dRot = b.dRotation.data();
+  const float *__restrict ipx = b.inPx.data(), *__restrict ipy = b.inPy.data(), *__restrict ipz = b.inPz.data();
+  const float *__restrict iqw = b.inQw.data(), *__restrict iqx = b.inQx.data(), *__restrict iqy = b.inQy.data(), *__restrict iqz = b.inQz.data();
+  const float *__restrict minCutoff = b.minCutoff.data(), *__restrict betaP = b.betaPosition.data();
+  const float *__restrict betaR = b.betaRotation.data(), *__restrict dCutoff = b.derivativeCutoff.data();
+  const float *__restrict reset = b.reset.data();
+  const float rdt = 1.0f / dt;
+
+#pragma clang loop vectorize(enable)
+  for (int i = 0; i < count; i++) {
+    const float keep = 1.0f - reset[i];
+    const float ad = lowPassAlpha(dt, dCutoff[i]);
+
+    // Position: smoothed velocity drives the cutoff.
+    dpx[i] = keep * (dpx[i] + ad * ((ipx[i] - px[i]) * rdt - dpx[i]));
+    dpy[i] = keep * (dpy[i] + ad * ((ipy[i] - py[i]) * rdt - dpy[i]));
+    dpz[i] = keep * (dpz[i] + ad * ((ipz[i] - pz[i]) * rdt - dpz[i]));
+    const float speed = sqrtf(dpx[i] * dpx[i] + dpy[i] * dpy[i] + dpz[i] * dpz[i]);
+    const float ap = lowPassAlpha(dt, minCutoff[i] + betaP[i] * speed) * keep + reset[i];
+    px[i] += ap * (ipx[i] - px[i]);
+    py[i] += ap * (ipy[i] - py[i]);
+    pz[i] += ap * (ipz[i] - pz[i]);
+
+    // Rotation: angular speed from the angle between filtered and sampled quaternions,
+    // using 2 * sin(theta / 2) ~= theta, which holds at per-frame rotation rates.
+    const float d = qw[i] * iqw[i] + qx[i] * iqx[i] + qy[i] * iqy[i] + qz[i] * iqz[i];
+    const float s = (d < 0.0f ? -1.0f : 1.0f);
+    const float angle = 2.0f * sqrtf(fmaxf(0.0f, 1.0f - d * d));
+    dRot[i] = keep * (dRot[i] + ad * (angle * rdt - dRot[i]));
+    const float ar = lowPassAlpha(dt, minCutoff[i] + betaR[i] * dRot[i]) * keep + reset[i];
+    const float w = qw[i] + ar * (s * iqw[i] - qw[i]);
+    const float x = qx[i] + ar * (s * iqx[i] - qx[i]);
+    const float y = qy[i] + ar * (s * iqy[i] - qy[i]);
+    const float z = qz[i] + ar * (s * iqz[i] - qz[i]);
+    const float n = 1.0f / sqrtf(w * w + x * x + y * y + z * z);
+    qw[i] = w * n; qx[i] = x * n; qy[i] = y * n; qz[i] = z * n;
+  }
+}
+
+void ARPoseFilterBatch::filterKalman(Bank &b, float dt) {
+  const int count = (int)b.entry.size();
+  float *__restrict px = b.px.data(), *__restrict py = b.py.data(), *__restrict pz = b.pz.data();
+  float *__restrict qw = b.qw.data(), *__restrict qx = b.qx.data(), *__restrict qy = b.qy.data(), *__restrict qz = b.qz.data();
+  float *__restrict vpx = b.vpx.data(), *__restrict vpy = b.vpy.data(), *__restrict vpz = b.vpz.data();
+  float *__restrict vqw = b.vqw.data(), *__restrict vqx = b.vqx.data(), *__restrict vqy = b.vqy.data(), *__restrict vqz = b.vqz.data();
+  float *__restrict pP00 = b.pP00.data(), *__restrict pP01 = b.pP01.data(), *__restrict pP11 = b.pP11.data();
+  float *__restrict rP00 = b.rP00.data(), *__restrict rP01 = b.rP01.data(), *__restrict rP11 = b.rP11.data();
+  const float *__restrict ipx = b.inPx.data(), *__restrict ipy = b.inPy.data(), *__restrict ipz = b.inPz.data();
+  const float *__restrict iqw = b.inQw.data(), *__restrict iqx = b.inQx.data(), *__restrict iqy = b.inQy.data(), *__restrict iqz = b.inQz.data();
+  const float *__restrict noiseP = b.noisePosition.data(), *__restrict noiseR = b.noiseRotation.data();
+  const float *__restrict varP = b.varPosition.data(), *__restrict varR = b.varRotation.data();
+  const float *__restrict reset = b.reset.data();
+  const float dt2 = dt * dt, dt3 = dt2 * dt, rdt2 = 1.0f / dt2;
+
+#pragma clang loop vectorize(enable)
+  for (int i = 0; i < count; i++) {
+    const float r = reset[i], keep = 1.0f - r;
+
+    // Position. Predict with constant velocity, then correct. The x, y and z axes share one
+    // covariance because they share noise parameters and time step.
+    {
+      const float P00 = pP00[i] + 2.0f * dt * pP01[i] + dt2 * pP11[i] + noiseP[i] * dt3 * (1.0f / 3.0f);
+      const float P01 = pP01[i] + dt * pP11[i] + noiseP[i] * dt2 * 0.5f;
+      const float P11 = pP11[i] + noiseP[i] * dt;
+      const float k0 = P00 / (P00 + varP[i]), k1 = P01 / (P00 + varP[i]);
+      const float ex = ipx[i] - (px[i] + vpx[i] * dt);
+      const float ey = ipy[i] - (py[i] + vpy[i] * dt);
+      const float ez = ipz[i] - (pz[i] + vpz[i] * dt);
+      // A reset takes the sample as-is, at rest, with the measurement variance.
+      px[i] = keep * (px[i] + vpx[i] * dt + k0 * ex) + r * ipx[i];
+      py[i] = keep * (py[i] + vpy[i] * dt + k0 * ey) + r * ipy[i];
+      pz[i] = keep * (pz[i] + vpz[i] * dt + k0 * ez) + r * ipz[i];
+      vpx[i] = keep * (vpx[i] + k1 * ex);
+      vpy[i] = keep * (vpy[i] + k1 * ey);
+      vpz[i] = keep * (vpz[i] + k1 * ez);
+      pP00[i] = keep * ((1.0f - k0) * P00) + r * varP[i];
+      pP01[i] = keep * ((1.0f - k0) * P01);
+      pP11[i] = keep * (P11 - k1 * P01) + r * varP[i] * rdt2;
+    }
+
+    // Rotation. The same model on the quaternion components, with the sample moved into the
+    // hemisphere of the prediction and the state renormalised afterwards.
+    {
+      const float P00 = rP00[i] + 2.0f * dt * rP01[i] + dt2 * rP11[i] + noiseR[i] * dt3 * (1.0f / 3.0f);
+      const float P01 = rP01[i] + dt * rP11[i] + noiseR[i] * dt2 * 0.5f;
+      const float P11 = rP11[i] + noiseR[i] * dt;
+      const float k0 = P00 / (P00 + varR[i]), k1 = P01 / (P00 + varR[i]);
+      const float fw = qw[i] + vqw[i] * dt, fx = qx[i] + vqx[i] * dt, fy = qy[i] + vqy[i] * dt, fz = qz[i] + vqz[i] * dt;
+      const float d = fw * iqw[i] + fx * iqx[i] + fy * iqy[i] + fz * iqz[i];
+      const float s = (d < 0.0f ? -1.0f : 1.0f);
+      const float ew = s * iqw[i] - fw, ex = s * iqx[i] - fx, ey = s * iqy[i] - fy, ez = s * iqz[i] - fz;
+      const float w = keep * (fw + k0 * ew) + r * iqw[i];
+      const float x = keep * (fx + k0 * ex) + r * iqx[i];
+      const float y = keep * (fy + k0 * ey) + r * iqy[i];
+      const float z = keep * (fz + k0 * ez) + r * iqz[i];
+      vqw[i] = keep * (vqw[i] + k1 * ew);
+      vqx[i] = keep * (vqx[i] + k1 * ex);
+      vqy[i] = keep * (vqy[i] + k1 * ey);
+      vqz[i] = keep * (vqz[i] + k1 * ez);
+      rP00[i] = keep * ((1.0f - k0) * P00) + r * varR[i];
+      rP01[i] = keep * ((1.0f - k0) * P01);
+      rP11[i] = keep * (P11 - k1 * P01) + r * varR[i] * rdt2;
+      const float n = 1.0f / sqrtf(w * w + x * x + y * y + z * z);
+      qw[i] = w * n; qx[i] = x * n; qy[i] = y * n; qz[i] = z * n;
+    }
+  }
+}
+
+// MARK: -
+
+void ARPoseFilterBatch::update(const AR2VideoTimestampT &frameTime) {
+  if (m_entries.empty()) return;
+
+  float dt = kDefaultDt;
+  if (m_lastUpdateTime.sec != 0 || m_lastUpdateTime.usec != 0) {
+    dt = (float)((double)(frameTime.sec - m_lastUpdateTime.sec) + ((double)frameTime.usec - (double)m_lastUpdateTime.usec) * 1e-6);
+    if (dt <= 0.0f) dt = kDefaultDt;
+    dt = fminf(fmaxf(dt, kMinDt), kMaxDt);
+  }
+  m_lastUpdateTime = frameTime;
+
+  for (int type = LowPass; type <= Kalman; type++) {
+    Bank &b = m_banks[type];
+    const int count = (int)b.entry.size();
+    if (count == 0) continue;
+
+    // Gather the visible poses into the input lanes. Hidden trackables feed back
+    // their own state with a reset, so the pass leaves them unchanged.
+    for (int i = 0; i < count; i++) {
+      Entry &e = m_entries[b.entry[i]];
+      const ARTrackable *trackable = e.trackable;
+      if (trackable->visible) {
+        float q[4], p[3];
+        quatPosFromMatrix(trackable->transformationMatrix, q, p);
+        b.inQw[i] = q[0]; b.inQx[i] = q[1]; b.inQy[i] = q[2]; b.inQz[i] = q[3];
+        b.inPx[i] = p[0]; b.inPy[i] = p[1]; b.inPz[i] = p[2];
+        b.reset[i] = (!trackable->visiblePrev || e.needsReset ? 1.0f : 0.0f);
+        e.needsReset = false;
+      } else {
+        b.inQw[i] = b.qw[i]; b.inQx[i] = b.qx[i]; b.inQy[i] = b.qy[i]; b.inQz[i] = b.qz[i];
+        b.inPx[i] = b.px[i]; b.inPy[i] = b.py[i]; b.inPz[i] = b.pz[i];
+        b.reset[i] = 1.0f;
+      }
+    }
+
+    switch (type) {
+      case LowPass: filterLowPass(b); break;
+      case OneEuro: filterOneEuro(b, dt); break;
+      case Kalman: filterKalman(b, dt); break;
+    }
+
+    // Scatter only the poses that will be read.
+    for (int i = 0; i < count; i++) {
+      if (!m_entries[b.entry[i]].trackable->visible) continue;
+      const float q[4] = {b.qw[i], b.qx[i], b.qy[i], b.qz[i]};
+      const float p[3] = {b.px[i], b.py[i], b.pz[i]};
+      matrixFromQuatPos(q, p, &m_output[b.entry[i] * 16]);
+    }
+  }
+}
+
+bool ARPoseFilterBatch::getTransformationMatrix(int UID, ARdouble mat[16]) const {
+  int index = indexOf(UID);
+  if (index == -1 || !m_entries[index].trackable->visible) return false;
+  std::copy(m_output.begin() + index * 16, m_output.begin() + (index + 1) * 16, mat);
+  return true;
+}
@@ -0,0 +1,80 @@
+//
+//  ARPoseHistory.h
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ARPoseHistory_h
+#define ARPoseHistory_h
+
+#include <AR6/AR/ar.h>
+
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Keeps a bounded ring of recent poses per trackable, each stamped with the capture
+ * time of the frame it was estimated from, and answers pose queries for arbitrary
+ * timestamps. Queries between two samples are interpolated; queries after the latest
+ * sample are extrapolated from the last two samples, up to a maximum horizon.
+ * Content not drawn over the camera image can ask for the pose at its expected display time
+ * to hide motion-to-photon latency, and other sensors can align to exact capture times.
+ * Video see-through overlays should use the pose of the frame being shown instead.
+ */
+class ARPoseHistory {
+
+private:
+  struct Sample {
+    double time;                        ///< Seconds, same epoch as the AR2VideoTimestampT passed in.
+    ARdouble q[4];
+    ARdouble p[3];
+  };
+
+  struct Ring {
+    std::vector<Sample> samples;
+    int head;                           ///< Index of the oldest sample.
+    int count;
+    const Sample &at(int i) const { return samples[(head + i) % samples.size()]; }
+  };
+
+  int m_capacity;
+  double m_maxExtrapolation;
+  std::unordered_map<int, Ring> m_rings;
+
+public:
+  /**
+   * @param capacity          Number of poses kept per trackable. Must be >= 2.
+   * @param maxExtrapolation  Furthest (seconds) a pose is predicted past the latest sample.
+   */
+  ARPoseHistory(int capacity = 16, ARdouble maxExtrapolation = 0.1);
+
+  /**
+   * Appends a pose, dropping the oldest one if the ring is full. Poses must be added in
+   * increasing time order; a pose not newer than the latest one is ignored.
+   * @param mat  OpenGL transformation matrix, e.g. ARTrackable::transformationMatrix.
+   */
+  void addPose(int UID, const AR2VideoTimestampT &time, const ARdouble mat[16]);
+
+  /** Forgets the poses of the trackable, e.g. when it is lost or removed. */
+  void removeTrackable(int UID);
+
+  void clear();
+
+  /**
+   * Computes the pose of the trackable at the given time.
+   * Before the oldest sample, the oldest pose is returned. Beyond the extrapolation horizon,
+   * the pose at the horizon is returned.
+   * @return false if no pose has been recorded for the trackable.
+   */
+  bool getPoseAt(int UID, const AR2VideoTimestampT &time, ARdouble mat[16]) const;
+
+  /**
+   * Copies the most recent pose of the trackable and, if time is non-NULL, its timestamp.
+   * @return false if no pose has been recorded for the trackable.
+   */
+  bool getLatestPose(int UID, AR2VideoTimestampT *time, ARdouble mat[16]) const;
+};
+
+#endif /* ARPoseHistory_h */
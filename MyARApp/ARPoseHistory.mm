@@ -0,0 +1,119 @@
+//
+//  ARPoseHistory.mm
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ARPoseHistory.h"
+#import "ARToolkitExtensions.h"
+
+#include <math.h>
+
+static inline double secondsFromTimestamp(const AR2VideoTimestampT &t) {
+  return (double)t.sec + (double)t.usec * 1e-6;
+}
+
+// Spherical interpolation from a (u = 0) to b (u = 1). Values of u > 1 extrapolate along the same arc.
+static void quatSlerp(const ARdouble a[4], const ARdouble b[4], double u, ARdouble out[4]) {
+  double d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+  const double sign = (d < 0.0 ? -1.0 : 1.0);
+  d *= sign;
+  double wa, wb;
+  if (d > 0.9995) {
+    // Nearly parallel: linear interpolation is accurate and avoids dividing by sin(theta) ~ 0.
+    wa = 1.0 - u; wb = u;
+  } else {
+    const double theta = acos(d);
+    const double st = sin(theta);
+    wa = sin((1.0 - u) * theta) / st; wb = sin(u * theta) / st;
+  }
+  wb *= sign;
+  double n = 0.0;
+  for (int i = 0; i < 4; i++) {
+    out[i] = wa * a[i] + wb * b[i];
+    n += out[i] * out[i];
+  }
+  n = 1.0 / sqrt(n);
+  for (int i = 0; i < 4; i++) out[i] *= n;
+}
+
+ARPoseHistory::ARPoseHistory(int capacity, ARdouble maxExtrapolation) :
+  m_capacity(capacity < 2 ? 2 : capacity),
+  m_maxExtrapolation(maxExtrapolation < 0.0 ? 0.0 : maxExtrapolation) {
+}
+
+void ARPoseHistory::addPose(int UID, const AR2VideoTimestampT &time, const ARdouble mat[16]) {
+  Ring &ring = m_rings[UID];
+  if (ring.samples.empty()) {
+    ring.samples.resize(m_capacity);
+    ring.head = ring.count = 0;
+  }
+  const double t = secondsFromTimestamp(time);
+  if (ring.count > 0 && t <= ring.at(ring.count - 1).time) return;
+
+  int slot;
+  if (ring.count < m_capacity) {
+    slot = (ring.head + ring.count) % m_capacity;
+    ring.count++;
+  } else {
+    slot = ring.head;
+    ring.head = (ring.head + 1) % m_capacity;
+  }
+  Sample &s = ring.samples[slot];
+  s.time = t;
+  ARQuatPosFromMatrix(mat, s.q, s.p);
+}
+
+void ARPoseHistory::removeTrackable(int UID) {
+  m_rings.erase(UID);
+}
+
+void ARPoseHistory::clear() {
+  m_rings.clear();
+}
+
+bool ARPoseHistory::getPoseAt(int UID, const AR2VideoTimestampT &time, ARdouble mat[16]) const {
+  auto it = m_rings.find(UID);
+  if (it == m_rings.end() || it->second.count == 0) return false;
+  const Ring &ring = it->second;
+
+  const Sample &latest = ring.at(ring.count - 1);
+  double t = secondsFromTimestamp(time);
+  if (ring.count == 1 || t <= ring.at(0).time) {
+    const Sample &s = (ring.count == 1 ? latest : ring.at(0));
+    ARMatrixFromQuatPos(s.q, s.p, mat);
+    return true;
+  }
+
+  // Pick the pair of samples bracketing t, or the last two when predicting past the latest.
+  int i = ring.count - 1;
+  if (t > latest.time) {
+    if (t > latest.time + m_maxExtrapolation) t = latest.time + m_maxExtrapolation;
+  } else {
+    while (i > 1 && ring.at(i - 1).time >= t) i--;
+  }
+  const Sample &a = ring.at(i - 1);
+  const Sample &b = ring.at(i);
+  const double u = (t - a.time) / (b.time - a.time);
+
+  ARdouble q[4], p[3];
+  quatSlerp(a.q, b.q, u, q);
+  for (int k = 0; k < 3; k++) p[k] = a.p[k] + u * (b.p[k] - a.p[k]);
+  ARMatrixFromQuatPos(q, p, mat);
+  return true;
+}
+
+bool ARPoseHistory::getLatestPose(int UID, AR2VideoTimestampT *time, ARdouble mat[16]) const {
+  auto it = m_rings.find(UID);
+  if (it == m_rings.end() || it->second.count == 0) return false;
+  const Sample &s = it->second.at(it->second.count - 1);
+  if (time) {
+    time->sec = (uint64_t)s.time;
+    time->usec = (uint32_t)((s.time - (double)time->sec) * 1e6 + 0.5);
+    if (time->usec >= 1000000) { time->sec++; time->usec -= 1000000; }
+  }
+  ARMatrixFromQuatPos(s.q, s.p, mat);
+  return true;
+}
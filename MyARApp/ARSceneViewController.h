@@ -8,10 +8,30 @@
 
 #import <UIKit/UIKit.h>
 #import <SceneKit/SceneKit.h>
+#ifdef __cplusplus
+#  include "ARFrameStats.h"
+#  include "ARLatencyStats.h"
+#endif
 
 @interface ARSceneViewController : UIViewController
 @property (weak, nonatomic, nullable) IBOutlet SCNView *sceneView;
 - (nonnull SCNScene *)createScene;
 - (void)addTrackable:(nonnull NSString *)imagePath width:(CGFloat)width height:(CGFloat)height;
 - (void)setupTrackables;
+/// Requests recording of the session; it starts on the next tracked frame. Returns NO if already recording.
+- (BOOL)startRecordingToDirectory:(nonnull NSString *)path jpeg:(BOOL)jpeg;
+- (void)stopRecording;
+#ifdef __cplusplus
+/// Statistics of the most recent tracked frames.
+- (nonnull const ARFrameStats *)frameStats;
+/// Capture-to-pose and capture-to-display latency of the most recent frames, per video source.
+- (nonnull const ARLatencyStats *)latencyStats;
+/**
+ * Predicts the pose of a trackable delay seconds from now, e.g. for the expected display time of
+ * content that is not drawn over the camera image. Overlays on the video use the frame's own pose.
+ * Waits for the frame being rendered; do not call from the renderer callbacks.
+ * @return NO if the trackable has no recent pose.
+ */
+- (BOOL)getPose:(nonnull ARdouble *)mat forTrackable:(int)trackableId inSeconds:(NSTimeInterval)delay;
+#endif
 @end
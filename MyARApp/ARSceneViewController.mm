@@ -8,11 +8,34 @@
 
 #import "ARSceneViewController.h"
 #import "ARToolkitExtensions.h"
+#import "ARAsyncLog.h"
+#import "ARPoseFilter.h"
+#import "ARPoseHistory.h"
+#import "ARSessionRecorder.h"
+#import "ARStartupProfile.h"
+#import "ARTrace.h"
 
 #include <AR6/ARController.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+static inline float millisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Monotonic timestamp for the pose filter and history, which expect time never to step backwards.
+static inline AR2VideoTimestampT steadyTimestamp(std::chrono::steady_clock::time_point t) {
+  const uint64_t us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+  return {us / 1000000, (uint32_t)(us % 1000000)};
+}
+
 @interface ARSceneViewController () <SCNSceneRendererDelegate> {
   ARController *arController;
+  std::atomic<bool> arReady;            ///< Trackables are loaded and the renderer may use arController.
+  std::mutex renderLock;                ///< Held by the renderer callbacks, so teardown can wait for them.
   int contextWidth;
   int contextHeight;
   bool contextRotate90;
@@ -22,6 +45,20 @@
   int32_t viewport[4];
   std::vector<int> trackableIds;
   std::vector<bool> trackableVisible;
+  ARPoseFilterBatch poseFilter;
+  ARPoseHistory poseHistory;
+  ARSessionRecorder recorder;
+  std::mutex recordingLock;
+  std::string recordingDirectory;       ///< Recording requested but not yet started, or empty.
+  bool recordingJPEG;
+  ARFrameStats frameStats;
+  ARLatencyStats latencyStats;
+  ARStartupProfile startupProfile;
+  uint64_t frameIndex;
+  std::chrono::steady_clock::time_point previousPollTime;
+  std::chrono::steady_clock::time_point lastArrivalEarliest;  ///< Previous poll: the frame had not arrived.
+  std::chrono::steady_clock::time_point lastArrivalLatest;    ///< Poll that returned the frame.
+  bool lastArrivalDisplayed;
 }
 @property (weak, nonatomic) SCNNode *cameraNode;
 @property (strong, nonatomic) NSMutableArray<SCNNode *> *trackableNodes;
@@ -103,7 +140,9 @@
   char *trackableConfig;
   // TODO: find out relation between height and h
   asprintf(&trackableConfig, "2d;%s;%f", resourcePath, height);
+  auto start = std::chrono::steady_clock::now();
   int trackableId = arController->addTrackable(trackableConfig);
+  startupProfile.addPhase("addTrackable", start);
   if (trackableId == -1) {
     ARLOGe("Error adding trackable.\n");
     return;
@@ -111,6 +150,7 @@
 
   trackableIds.push_back(trackableId);
   trackableVisible.push_back(false); // not visible by default
+  poseFilter.setFiltered(arController->findTrackable(trackableId), true);
   SCNPlane *plane = [SCNPlane planeWithWidth:width height:height];
   plane.firstMaterial.diffuse.contents = [UIColor redColor];
   plane.firstMaterial.transparency = 0.5f;
@@ -130,12 +170,25 @@
 
   [EAGLContext setCurrentContext:self.sceneView.eaglContext];
 
+  // Keep log output off the tracking thread.
+  ARAsyncLogStart(NULL, NULL);
+  startupProfile.begin();
+
   // Initialise the ARController.
+  auto start = std::chrono::steady_clock::now();
   arController = new ARController();
   if (!arController->initialiseBase()) {
     ARLOGe("Error initialising ARController.\n");
     return;
   }
+  startupProfile.addPhase("initialiseBase", start);
+
+  // Start video before adding trackables, so that the video module opens the camera and loads
+  // its parameters while addTrackable() decodes the images. Its cost shows up in the first frame
+  // milestone, together with the 2D tracker feature sets, which libAR6 builds on the first update().
+  start = std::chrono::steady_clock::now();
+  arController->startRunning(vconf, NULL, NULL, 0);
+  startupProfile.addPhase("startRunning", start);
 
   // Add trackables.
 #ifdef DEBUG
@@ -143,35 +196,181 @@
   ARLOGe("CWD is '%s'.\n", getcwd(buf, sizeof(buf)));
 #endif
 
+  start = std::chrono::steady_clock::now();
   [self setupTrackables];
+  startupProfile.addPhase("setupTrackables", start);
 
+  // Set after startRunning(), but before the 2D tracker starts: that happens in the first update(),
+  // which the renderer does not call until arReady is set.
   arController->get2DTracker().setMaxSimultaneousTrackedImages((int)trackableIds.size());
 
-  // Start tracking.
-  arController->startRunning(vconf, NULL, NULL, 0);
+  // ARController is not thread-safe; the renderer waits until loading is done.
+  arReady = true;
 }
 
 - (void)tearDownAR {
+  // Wait for a frame in flight on the render thread; later callbacks see arReady unset and return
+  // before tracing or using arController. The trace can then be exported while nothing records.
+  self.sceneView.delegate = nil;
+  {
+    std::lock_guard<std::mutex> lock(renderLock);
+    arReady = false;
+  }
   if (arController) {
+    [self stopRecording];
+    poseFilter.clear();
+    poseHistory.clear();
+    latencyStats.clear();
     arController->displayFrameFinal(0);
     arController->shutdown();
     delete arController;
   }
+#if ARTRACE_ENABLED
+  ARTracePrintStats();
+  NSString *tracePath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"MyARApp.trace.json"];
+  if (ARTraceWriteChromeJSON(tracePath.fileSystemRepresentation)) {
+    ARLOGi("Trace written to '%s'.\n", tracePath.fileSystemRepresentation);
+  }
+#endif
+  ARAsyncLogStop();
+}
+
+// MARK: - Recording
+
+- (BOOL)startRecordingToDirectory:(NSString *)path jpeg:(BOOL)jpeg {
+  std::lock_guard<std::mutex> lock(recordingLock);
+  if (recorder.isRecording() || !recordingDirectory.empty()) return NO;
+  recordingDirectory = path.fileSystemRepresentation;
+  recordingJPEG = jpeg;
+  return YES;
+}
+
+- (void)stopRecording {
+  std::lock_guard<std::mutex> lock(recordingLock);
+  recordingDirectory.clear();
+  recorder.stop();
+}
+
+// Starts a requested recording once video is running. Called on the render thread, the only
+// thread that uses arController; never waits on a concurrent -stopRecording.
+- (void)startRequestedRecording {
+  std::unique_lock<std::mutex> lock(recordingLock, std::try_to_lock);
+  if (!lock.owns_lock() || recordingDirectory.empty()) return;
+  int width, height;
+  if (!arController->videoParameters(0, &width, &height, NULL)) return;
+  ARSessionRecorder::Format format = (recordingJPEG ? ARSessionRecorder::JPEG : ARSessionRecorder::Raw);
+  recorder.start(recordingDirectory.c_str(), format, width, height, (int)trackableIds.size());
+  recordingDirectory.clear();
+}
+
+// MARK: - Statistics
+
+- (const ARFrameStats *)frameStats {
+  return &frameStats;
+}
+
+- (const ARLatencyStats *)latencyStats {
+  return &latencyStats;
+}
+
+// MARK: - Pose Prediction
+
+- (BOOL)getPose:(ARdouble *)mat forTrackable:(int)trackableId inSeconds:(NSTimeInterval)delay {
+  std::lock_guard<std::mutex> lock(renderLock);
+  if (!arReady) return NO;
+  auto time = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(delay));
+  return poseHistory.getPoseAt(trackableId, steadyTimestamp(time), mat);
 }
 
 // MARK: - Scene Renderer Delegate
 
 - (void)renderer:(id<SCNSceneRenderer>)renderer updateAtTime:(NSTimeInterval)time {
-  bool gotFrame = arController->capture();
+  std::lock_guard<std::mutex> lock(renderLock);
+  if (!arReady) return;
+  ARTRACE_SCOPE("frame");
+  ARFrameStatsRecord stats = {};
+  bool gotFrame;
+  auto pollTime = std::chrono::steady_clock::now();
+  {
+    ARTRACE_SCOPE("capture");
+    gotFrame = arController->capture();
+    stats.captureMs = millisecondsSince(pollTime);
+  }
+  // The frame arrived after the previous poll began and before this one did, as capture() does not
+  // wait for frames. Latencies are measured from both, giving lower and upper bounds.
+  auto arrivalEarliest = (previousPollTime.time_since_epoch().count() != 0 ? previousPollTime : pollTime);
+  previousPollTime = pollTime;
   if (gotFrame) {
-    if (!arController->update()) {
-      ARLOGe("Error in ARController::update().\n");
-      return;
+    // ARController does not expose the frame buffer timestamp; the capture return is the closest proxy.
+    const AR2VideoTimestampT frameTime = steadyTimestamp(std::chrono::steady_clock::now());
+    {
+      ARTRACE_SCOPE("update");
+      auto start = std::chrono::steady_clock::now();
+      latencyStats.add(0, ARLatencyStats::TrackerStart, millisecondsSince(pollTime), millisecondsSince(arrivalEarliest));
+      if (!arController->update()) {
+        ARLOGe_LIMITED(1.0, "Error in ARController::update().\n");
+        return;
+      }
+      stats.updateMs = millisecondsSince(start);
+      latencyStats.add(0, ARLatencyStats::TrackerEnd, millisecondsSince(pollTime), millisecondsSince(arrivalEarliest));
+    }
+    {
+      ARTRACE_SCOPE("filter");
+      auto start = std::chrono::steady_clock::now();
+      poseFilter.update(frameTime);
+
+      for (int trackableId : trackableIds) {
+        ARdouble pose[16];
+        if (poseFilter.getTransformationMatrix(trackableId, pose)) {
+          poseHistory.addPose(trackableId, frameTime, pose);
+        } else {
+          poseHistory.removeTrackable(trackableId);
+        }
+      }
+      stats.filterMs = millisecondsSince(start);
+    }
+    latencyStats.add(0, ARLatencyStats::PosePublish, millisecondsSince(pollTime), millisecondsSince(arrivalEarliest));
+    lastArrivalEarliest = arrivalEarliest;
+    lastArrivalLatest = pollTime;
+    lastArrivalDisplayed = false;
+
+    stats.frameIndex = frameIndex++;
+    stats.frameTime = frameTime;
+    stats.trackableCount = (int)trackableIds.size();
+    for (size_t i = 0; i < trackableIds.size(); i++) {
+      ARTrackable *trackable = arController->findTrackable(trackableIds[i]);
+      bool visible = (trackable && trackable->visible);
+      if (visible) {
+        stats.visibleCount++;
+        // The 2D tracker identifies its images by trackable UID.
+        if (trackable->type == ARTrackable::TwoD) stats.visibleFeatureCount += arController->get2DTracker().getFeatureCount(trackable->UID);
+      }
+      if (visible && !trackableVisible[i]) stats.acquiredCount++;
+      if (!visible && trackableVisible[i]) stats.lostCount++;
+      trackableVisible[i] = visible;
+    }
+    if (!startupProfile.isFinished()) {
+      if (stats.frameIndex == 0) startupProfile.mark("first frame tracked");
+      if (stats.visibleCount > 0) {
+        startupProfile.mark("first pose");
+        startupProfile.finish();
+      }
+    }
+    stats.maxSimultaneousTrackedImages = arController->get2DTracker().getMaxSimultaneousTrackedImages();
+    frameStats.add(stats);
+
+    {
+      ARTRACE_SCOPE("record");
+      [self startRequestedRecording];
+      recorder.record(arController, frameTime, trackableIds);
     }
   }
 }
 
 - (void)renderer:(id<SCNSceneRenderer>)renderer willRenderScene:(SCNScene *)scene atTime:(NSTimeInterval)time {
+  std::lock_guard<std::mutex> lock(renderLock);
+  if (!arReady) return;
+  ARTRACE_SCOPE("render");
   [EAGLContext setCurrentContext:self.sceneView.eaglContext];
 
   if (arController->isRunning()) {
@@ -182,7 +381,10 @@
     }
 
     // Display the current video frame to the current OpenGL context.
-    arController->displayFrame(0);
+    {
+      ARTRACE_SCOPE("displayFrame");
+      arController->displayFrame(0);
+    }
     
     // Get the projection matrix
     SCNMatrix4 projectionMatrix;
@@ -201,15 +403,26 @@
       projectionMatrix = SCNMatrix4Rotate(projectionMatrix, (M_PI * 90)/180, 0, 0, -1);
     }
     
-    // Look for trackables, and draw on each found one.
+    const uint32_t displayDelayUs = (uint32_t)(1000000 / [UIScreen mainScreen].maximumFramesPerSecond);
+    if (frameIndex > 0 && !lastArrivalDisplayed) {
+      // Estimated: SceneKit does not report when the drawable is presented.
+      const float displayDelayMs = displayDelayUs * 1e-3f;
+      latencyStats.add(0, ARLatencyStats::Display, millisecondsSince(lastArrivalLatest) + displayDelayMs,
+                       millisecondsSince(lastArrivalEarliest) + displayDelayMs);
+      lastArrivalDisplayed = true;
+    }
+
+    // Look for trackables, and draw on each found one. The overlay must match the video frame
+    // drawn behind it, so it uses the pose from that frame rather than a prediction.
     size_t trackableCount = trackableIds.size();
     for (size_t i = 0; i < trackableCount; i++) {
       // Find the trackable for the given trackable ID.
       ARTrackable *trackable = arController->findTrackable(trackableIds[i]);
       SCNCamera *camera = self.cameraNode.camera;
       SCNNode *trackableNode = self.trackableNodes[i];
-      if (trackable->visible) {
-        transformMatrix = SCNMatrix4Make(trackable->transformationMatrix);
+      ARdouble pose[16];
+      if (trackable->visible && poseHistory.getLatestPose(trackableIds[i], NULL, pose)) {
+        transformMatrix = SCNMatrix4Make(pose);
         camera.projectionTransform = projectionMatrix;
         trackableNode.transform = transformMatrix;
         trackableNode.opacity = 1;
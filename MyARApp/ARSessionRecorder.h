@@ -0,0 +1,134 @@
+//
+//  ARSessionRecorder.h
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ARSessionRecorder_h
+#define ARSessionRecorder_h
+
+#include <AR6/ARController.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Tees video frames and per-frame tracking results to disk without stalling the tracking thread.
+ * record() copies the frame and results into a preallocated slot of a lock-free single-producer,
+ * single-consumer ring; a background thread writes the slots out. When the writer falls behind,
+ * frames are dropped and counted rather than waited for.
+ *
+ * Output, in the directory passed to start():
+ * - Raw: "session.arrec", a memory-mappable sequence of fixed-size records (see FrameHeader),
+ *   each followed by its TrackableResult array and RGBA pixels.
+ * - JPEG: "frame-NNNNNN.jpg" per frame via arVideoSaveImageJPEG(), plus "results.txt" with a
+ *   line per saved frame. libjpeg takes RGB only, so the writer thread converts each frame.
+ */
+class ARSessionRecorder {
+
+public:
+  enum Format {
+    Raw,
+    JPEG
+  };
+
+  struct TrackableResult {
+    int32_t UID;
+    int32_t visible;
+    double transformationMatrix[16];
+  };
+
+  struct FrameHeader {
+    char magic[4];                      ///< "ARRF".
+    uint32_t frameIndex;
+    uint64_t sec;
+    uint32_t usec;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pixelFormat;               ///< Always AR_PIXEL_FORMAT_RGBA.
+    uint32_t trackableCount;
+    uint32_t reserved;
+  };
+
+private:
+  struct Slot {
+    FrameHeader header;
+    std::vector<TrackableResult> results;
+    std::vector<uint32_t> pixels;
+    std::vector<ARUint8> rgb;           ///< JPEG only: pixels converted by the writer thread.
+  };
+
+  Format m_format;
+  std::string m_directory;
+  int m_jpegQuality;
+  double m_minInterval;
+  int m_width;
+  int m_height;
+
+  std::vector<Slot> m_slots;
+  std::atomic<uint32_t> m_head;         ///< Next slot to write out. Advanced by the writer thread only.
+  std::atomic<uint32_t> m_tail;         ///< Next slot to fill. Advanced by record() only.
+  std::atomic<bool> m_running;
+  std::mutex m_controlLock;             ///< Held by start() and stop(); record() only tries it, so it never waits.
+  std::thread m_writer;
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wake;
+  FILE *m_rawFile;
+  FILE *m_resultsFile;
+
+  double m_lastRecordTime;              ///< Guarded by m_controlLock.
+  uint32_t m_frameIndex;                ///< Guarded by m_controlLock.
+  std::atomic<uint64_t> m_framesRecorded;
+  std::atomic<uint64_t> m_framesDropped;
+  std::atomic<uint64_t> m_framesSkipped;
+  std::atomic<uint64_t> m_framesFailed;
+
+  void writerLoop();
+  bool write(Slot &slot);
+
+public:
+  ARSessionRecorder();
+  ~ARSessionRecorder();
+
+  /**
+   * Opens the output and starts the writer thread.
+   * @param directory          Existing directory to write into.
+   * @param format             Raw container or JPEG frames.
+   * @param width              Video frame width, as reported by ARController::videoParameters().
+   * @param height             Video frame height.
+   * @param maxTrackables      Largest number of trackable results recorded per frame.
+   * @param maxFramesPerSecond Rate limit; frames arriving faster are skipped. 0 records every frame.
+   * @param queueDepth         Number of preallocated frame slots.
+   * @return false if already recording or the output could not be opened.
+   */
+  bool start(const char *directory, Format format, int width, int height, int maxTrackables,
+             double maxFramesPerSecond = 10.0, int queueDepth = 4);
+
+  /** Writes out any queued frames, then closes the output. */
+  void stop();
+
+  bool isRecording() const;
+
+  /**
+   * Queues the current video frame and the state of the given trackables.
+   * Never blocks on disk or on start()/stop(); if no slot is free the frame is dropped.
+   * Call on the thread that calls ARController::update(), after it. start() and stop() may be
+   * called from other threads.
+   */
+  void record(ARController *arController, const AR2VideoTimestampT &frameTime,
+              const std::vector<int> &trackableIds);
+
+  uint64_t framesRecorded() const;
+  uint64_t framesDropped() const;       ///< Frames lost because the writer was behind.
+  uint64_t framesSkipped() const;       ///< Frames left out by the rate limit.
+  uint64_t framesFailed() const;        ///< Frames that could not be written to disk.
+};
+
+#endif /* ARSessionRecorder_h */
@@ -0,0 +1,215 @@
+//
+//  ARSessionRecorder.mm
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ARSessionRecorder.h"
+
+#include <AR6/ARVideo/video.h>
+
+#include <chrono>
+#include <string.h>
+
+ARSessionRecorder::ARSessionRecorder() :
+  m_format(Raw),
+  m_jpegQuality(90),
+  m_minInterval(0.0),
+  m_width(0),
+  m_height(0),
+  m_head(0),
+  m_tail(0),
+  m_running(false),
+  m_rawFile(NULL),
+  m_resultsFile(NULL),
+  m_lastRecordTime(0.0),
+  m_frameIndex(0),
+  m_framesRecorded(0),
+  m_framesDropped(0),
+  m_framesSkipped(0),
+  m_framesFailed(0) {
+}
+
+ARSessionRecorder::~ARSessionRecorder() {
+  stop();
+}
+
+bool ARSessionRecorder::start(const char *directory, Format format, int width, int height, int maxTrackables,
+                              double maxFramesPerSecond, int queueDepth) {
+  std::lock_guard<std::mutex> lock(m_controlLock);
+  if (m_running || !directory || width <= 0 || height <= 0 || maxTrackables < 0 || queueDepth < 1) return false;
+
+  m_directory = directory;
+  m_format = format;
+  if (format == Raw) {
+    m_rawFile = fopen((m_directory + "/session.arrec").c_str(), "wb");
+    if (!m_rawFile) {
+      ARLOGe("Error opening session recording in '%s'.\n", directory);
+      return false;
+    }
+  } else {
+    m_resultsFile = fopen((m_directory + "/results.txt").c_str(), "w");
+    if (!m_resultsFile) {
+      ARLOGe("Error opening session recording in '%s'.\n", directory);
+      return false;
+    }
+  }
+
+  // All memory is allocated here, so that record() never allocates.
+  m_width = width;
+  m_height = height;
+  m_slots.assign(queueDepth, Slot());
+  for (Slot &slot : m_slots) {
+    slot.results.reserve(maxTrackables);
+    slot.pixels.resize((size_t)width * height);
+    if (format == JPEG) slot.rgb.resize((size_t)width * height * 3);
+  }
+  m_minInterval = (maxFramesPerSecond > 0.0 ? 1.0 / maxFramesPerSecond : 0.0);
+  m_lastRecordTime = 0.0;
+  m_frameIndex = 0;
+  m_head = m_tail = 0;
+  m_framesRecorded = m_framesDropped = m_framesSkipped = m_framesFailed = 0;
+
+  m_running = true;
+  m_writer = std::thread(&ARSessionRecorder::writerLoop, this);
+  return true;
+}
+
+void ARSessionRecorder::stop() {
+  std::lock_guard<std::mutex> lock(m_controlLock);
+  if (!m_running) return;
+  m_running = false;
+  m_wake.notify_one();
+  m_writer.join();
+  if (m_rawFile) {
+    fclose(m_rawFile);
+    m_rawFile = NULL;
+  }
+  if (m_resultsFile) {
+    fclose(m_resultsFile);
+    m_resultsFile = NULL;
+  }
+  ARLOGi("Session recording stopped: %llu frames recorded, %llu dropped, %llu skipped, %llu failed.\n",
+         (unsigned long long)m_framesRecorded, (unsigned long long)m_framesDropped, (unsigned long long)m_framesSkipped,
+         (unsigned long long)m_framesFailed);
+  if (m_framesFailed > 0) {
+    ARLOGe("Error writing %llu frames of the session recording.\n", (unsigned long long)m_framesFailed);
+  }
+}
+
+bool ARSessionRecorder::isRecording() const {
+  return m_running;
+}
+
+void ARSessionRecorder::record(ARController *arController, const AR2VideoTimestampT &frameTime,
+                               const std::vector<int> &trackableIds) {
+  // While start() or stop() is reallocating slots or joining the writer, the frame is left out.
+  std::unique_lock<std::mutex> lock(m_controlLock, std::try_to_lock);
+  if (!lock.owns_lock() || !m_running) return;
+
+  const double t = (double)frameTime.sec + (double)frameTime.usec * 1e-6;
+  if (m_lastRecordTime != 0.0 && t - m_lastRecordTime < m_minInterval) {
+    m_framesSkipped++;
+    return;
+  }
+
+  const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+  if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) {
+    m_framesDropped++;
+    return;
+  }
+  Slot &slot = m_slots[tail % m_slots.size()];
+
+  if (!arController->getFrameTextureRGBA32(0, slot.pixels.data())) return;
+  slot.results.clear();
+  for (int trackableId : trackableIds) {
+    if (slot.results.size() == slot.results.capacity()) break;
+    ARTrackable *trackable = arController->findTrackable(trackableId);
+    if (!trackable) continue;
+    TrackableResult result;
+    result.UID = trackable->UID;
+    result.visible = trackable->visible;
+    for (int i = 0; i < 16; i++) result.transformationMatrix[i] = trackable->transformationMatrix[i];
+    slot.results.push_back(result);
+  }
+  FrameHeader &h = slot.header;
+  memcpy(h.magic, "ARRF", 4);
+  h.frameIndex = m_frameIndex++;
+  h.sec = frameTime.sec;
+  h.usec = frameTime.usec;
+  h.width = (uint32_t)m_width;
+  h.height = (uint32_t)m_height;
+  h.pixelFormat = AR_PIXEL_FORMAT_RGBA;
+  h.trackableCount = (uint32_t)slot.results.size();
+  h.reserved = 0;
+
+  m_tail.store(tail + 1, std::memory_order_release);
+  m_lastRecordTime = t;
+  m_wake.notify_one();
+}
+
+void ARSessionRecorder::writerLoop() {
+  while (true) {
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire)) {
+      if (!m_running) break;
+      // The producer does not take the mutex, so a wakeup can be missed; the timeout bounds the delay.
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wake.wait_for(lock, std::chrono::milliseconds(10));
+      continue;
+    }
+    if (write(m_slots[head % m_slots.size()])) {
+      m_framesRecorded++;
+    } else {
+      m_framesFailed++;
+    }
+    m_head.store(head + 1, std::memory_order_release);
+  }
+}
+
+bool ARSessionRecorder::write(Slot &slot) {
+  const FrameHeader &h = slot.header;
+  if (m_format == Raw) {
+    return (fwrite(&h, sizeof(h), 1, m_rawFile) == 1 &&
+            fwrite(slot.results.data(), sizeof(TrackableResult), slot.results.size(), m_rawFile) == slot.results.size() &&
+            fwrite(slot.pixels.data(), sizeof(uint32_t), slot.pixels.size(), m_rawFile) == slot.pixels.size());
+  }
+
+  const ARUint8 *src = (const ARUint8 *)slot.pixels.data();
+  ARUint8 *dst = slot.rgb.data();
+  for (size_t i = 0; i < slot.pixels.size(); i++, src += 4, dst += 3) {
+    dst[0] = src[0];
+    dst[1] = src[1];
+    dst[2] = src[2];
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "/frame-%06u.jpg", h.frameIndex);
+  if (arVideoSaveImageJPEG((int)h.width, (int)h.height, AR_PIXEL_FORMAT_RGB, slot.rgb.data(),
+                           (m_directory + name).c_str(), m_jpegQuality, 0) < 0) {
+    return false;
+  }
+  fprintf(m_resultsFile, "%u %llu.%06u", h.frameIndex, (unsigned long long)h.sec, h.usec);
+  for (const TrackableResult &r : slot.results) {
+    fprintf(m_resultsFile, " %d %d", r.UID, r.visible);
+    for (int i = 0; i < 16; i++) fprintf(m_resultsFile, " %.9g", r.transformationMatrix[i]);
+  }
+  return (fputc('\n', m_resultsFile) != EOF);
+}
+
+uint64_t ARSessionRecorder::framesRecorded() const {
+  return m_framesRecorded;
+}
+
+uint64_t ARSessionRecorder::framesDropped() const {
+  return m_framesDropped;
+}
+
+uint64_t ARSessionRecorder::framesSkipped() const {
+  return m_framesSkipped;
+}
+
+uint64_t ARSessionRecorder::framesFailed() const {
+  return m_framesFailed;
+}
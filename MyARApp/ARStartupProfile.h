@@ -0,0 +1,55 @@
+//
+//  ARStartupProfile.h
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ARStartupProfile_h
+#define ARStartupProfile_h
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * Breaks down AR startup into timed phases and milestones (first frame, first pose),
+ * relative to the start of setup and to the launch of the process.
+ */
+class ARStartupProfile {
+
+public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+
+private:
+  struct Entry {
+    std::string name;
+    double startMs;                     ///< Since begin().
+    double durationMs;                  ///< Negative for milestones.
+  };
+
+  TimePoint m_origin;
+  double m_processAgeMs;                ///< Time from process launch to begin(), or negative if unknown.
+  std::vector<Entry> m_entries;
+  bool m_finished;
+
+public:
+  ARStartupProfile();
+
+  /** Starts a new profile. */
+  void begin();
+
+  /** Records a phase that started at start and ends now. */
+  void addPhase(const char *name, TimePoint start);
+
+  /** Records a milestone reached now. */
+  void mark(const char *name);
+
+  /** Logs the profile. Later phases and milestones are ignored until the next begin(). */
+  void finish();
+
+  bool isFinished() const { return m_finished; }
+};
+
+#endif /* ARStartupProfile_h */
@@ -0,0 +1,77 @@
+//
+//  ARStartupProfile.mm
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ARStartupProfile.h"
+
+#include <AR6/ARUtil/log.h>
+
+#ifdef __APPLE__
+#  include <sys/sysctl.h>
+#  include <sys/time.h>
+#  include <unistd.h>
+#endif
+
+// Time since the process was launched, in milliseconds, or -1 if unknown.
+static double processAgeMs() {
+#ifdef __APPLE__
+  struct kinfo_proc info;
+  size_t size = sizeof(info);
+  int mib[4] = {CTL_KERN, KERN_PROC, KERN_PROC_PID, getpid()};
+  if (sysctl(mib, 4, &info, &size, NULL, 0) == 0 && size > 0) {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    const struct timeval &start = info.kp_proc.p_starttime;
+    return (now.tv_sec - start.tv_sec) * 1e3 + (now.tv_usec - start.tv_usec) * 1e-3;
+  }
+#endif
+  return -1.0;
+}
+
+static inline double millisecondsBetween(ARStartupProfile::TimePoint from, ARStartupProfile::TimePoint to) {
+  return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+ARStartupProfile::ARStartupProfile() :
+  m_origin(std::chrono::steady_clock::now()),
+  m_processAgeMs(-1.0),
+  m_finished(true) {
+}
+
+void ARStartupProfile::begin() {
+  m_origin = std::chrono::steady_clock::now();
+  m_processAgeMs = processAgeMs();
+  m_entries.clear();
+  m_finished = false;
+}
+
+void ARStartupProfile::addPhase(const char *name, TimePoint start) {
+  if (m_finished) return;
+  const TimePoint now = std::chrono::steady_clock::now();
+  m_entries.push_back({name, millisecondsBetween(m_origin, start), millisecondsBetween(start, now)});
+}
+
+void ARStartupProfile::mark(const char *name) {
+  if (m_finished) return;
+  m_entries.push_back({name, millisecondsBetween(m_origin, std::chrono::steady_clock::now()), -1.0});
+}
+
+void ARStartupProfile::finish() {
+  if (m_finished) return;
+  m_finished = true;
+  if (m_processAgeMs >= 0.0) {
+    ARLOGi("Startup: setup began %.1f ms after process launch.\n", m_processAgeMs);
+  }
+  ARLOGi("Startup: %-24s %10s %10s\n", "phase", "at (ms)", "took (ms)");
+  for (const Entry &e : m_entries) {
+    if (e.durationMs < 0.0) {
+      ARLOGi("Startup: %-24s %10.1f %10s\n", e.name.c_str(), e.startMs, "-");
+    } else {
+      ARLOGi("Startup: %-24s %10.1f %10.1f\n", e.name.c_str(), e.startMs, e.durationMs);
+    }
+  }
+}
@@ -10,3 +10,9 @@
 #include <AR6/ARController.h>
 
 SCNMatrix4 SCNMatrix4Make(const ARdouble mat[16]);
+
+/// Splits an OpenGL transformation matrix into a unit quaternion (w, x, y, z) and a position.
+void ARQuatPosFromMatrix(const ARdouble m[16], ARdouble q[4], ARdouble p[3]);
+
+/// Builds an OpenGL transformation matrix from a unit quaternion (w, x, y, z) and a position.
+void ARMatrixFromQuatPos(const ARdouble q[4], const ARdouble p[3], ARdouble m[16]);
@@ -16,3 +16,34 @@ SCNMatrix4 SCNMatrix4Make(const ARdouble mat[16]) {
     mat[12], mat[13], mat[14], mat[15],
   };
 }
+
+// OpenGL matrices are column-major: element (row, col) is at m[col * 4 + row].
+void ARQuatPosFromMatrix(const ARdouble m[16], ARdouble q[4], ARdouble p[3]) {
+  const ARdouble r00 = m[0], r10 = m[1], r20 = m[2];
+  const ARdouble r01 = m[4], r11 = m[5], r21 = m[6];
+  const ARdouble r02 = m[8], r12 = m[9], r22 = m[10];
+  const ARdouble trace = r00 + r11 + r22;
+  ARdouble s;
+  if (trace > 0) {
+    s = 0.5 / sqrt(trace + 1.0);
+    q[0] = 0.25 / s; q[1] = (r21 - r12) * s; q[2] = (r02 - r20) * s; q[3] = (r10 - r01) * s;
+  } else if (r00 > r11 && r00 > r22) {
+    s = 2.0 * sqrt(1.0 + r00 - r11 - r22);
+    q[0] = (r21 - r12) / s; q[1] = 0.25 * s; q[2] = (r01 + r10) / s; q[3] = (r02 + r20) / s;
+  } else if (r11 > r22) {
+    s = 2.0 * sqrt(1.0 + r11 - r00 - r22);
+    q[0] = (r02 - r20) / s; q[1] = (r01 + r10) / s; q[2] = 0.25 * s; q[3] = (r12 + r21) / s;
+  } else {
+    s = 2.0 * sqrt(1.0 + r22 - r00 - r11);
+    q[0] = (r10 - r01) / s; q[1] = (r02 + r20) / s; q[2] = (r12 + r21) / s; q[3] = 0.25 * s;
+  }
+  p[0] = m[12]; p[1] = m[13]; p[2] = m[14];
+}
+
+void ARMatrixFromQuatPos(const ARdouble q[4], const ARdouble p[3], ARdouble m[16]) {
+  const ARdouble w = q[0], x = q[1], y = q[2], z = q[3];
+  m[0] = 1 - 2 * (y * y + z * z); m[1] = 2 * (x * y + w * z);     m[2] = 2 * (x * z - w * y);      m[3] = 0;
+  m[4] = 2 * (x * y - w * z);     m[5] = 1 - 2 * (x * x + z * z); m[6] = 2 * (y * z + w * x);      m[7] = 0;
+  m[8] = 2 * (x * z + w * y);     m[9] = 2 * (y * z - w * x);     m[10] = 1 - 2 * (x * x + y * y); m[11] = 0;
+  m[12] = p[0]; m[13] = p[1]; m[14] = p[2]; m[15] = 1;
+}
@@ -0,0 +1,68 @@
+//
+//  ARTrace.h
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ARTrace_h
+#define ARTrace_h
+
+#include <stdint.h>
+
+/**
+ * Scoped, per-thread tracing profiler.
+ * Each ARTRACE_SCOPE("name") records the start and end of the enclosing block into a buffer
+ * owned by the calling thread, so recording takes no locks. Scopes nest. The recorded events
+ * can be exported as Chrome/Perfetto trace JSON, or aggregated into per-scope statistics.
+ *
+ * Tracing is compiled in only when ARTRACE_ENABLED is non-zero (Debug builds). Otherwise
+ * ARTRACE_SCOPE expands to nothing and the functions below do nothing.
+ */
+
+#ifndef ARTRACE_ENABLED
+#  define ARTRACE_ENABLED 0
+#endif
+
+#define ARTRACE_CONCAT2(a, b) a##b
+#define ARTRACE_CONCAT(a, b) ARTRACE_CONCAT2(a, b)
+
+#if ARTRACE_ENABLED
+#  define ARTRACE_SCOPE(name) ARTraceScope ARTRACE_CONCAT(arTraceScope, __LINE__)(name)
+#else
+#  define ARTRACE_SCOPE(name)
+#endif
+
+/// Events kept per thread. The oldest events are overwritten once a thread's buffer is full.
+#define ARTRACE_EVENTS_PER_THREAD 16384
+
+class ARTraceScope {
+private:
+  const char *m_name;                   ///< Must be a string literal, or otherwise outlive the trace.
+  uint64_t m_start;
+
+public:
+  explicit ARTraceScope(const char *name);
+  ~ARTraceScope();
+  ARTraceScope(const ARTraceScope &) = delete;
+  ARTraceScope &operator=(const ARTraceScope &) = delete;
+};
+
+/** Discards all recorded events. Do not call while other threads are tracing. */
+void ARTraceClear(void);
+
+/**
+ * Writes all recorded events as Chrome trace JSON, viewable in chrome://tracing or Perfetto.
+ * Do not call while other threads are tracing: their events may be read half-written.
+ * @return false if the file could not be written, or tracing is compiled out.
+ */
+bool ARTraceWriteChromeJSON(const char *path);
+
+/**
+ * Logs count, total, mean and max duration of every scope, indented by nesting depth.
+ * Do not call while other threads are tracing.
+ */
+void ARTracePrintStats(void);
+
+#endif /* ARTrace_h */
@@ -0,0 +1,181 @@
+//
+//  ARTrace.mm
+//  MyARApp
+//
+//  Created by agent on 10/19/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "ARTrace.h"
+
+#if ARTRACE_ENABLED
+
+#include <AR6/ARUtil/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Event {
+  const char *name;
+  uint64_t start;                       ///< Nanoseconds, steady clock.
+  uint64_t end;
+  uint32_t depth;
+};
+
+// Written only by its own thread; read by the exporters.
+struct ThreadBuffer {
+  uint32_t tid;
+  uint32_t depth;
+  std::atomic<uint64_t> count;
+  Event events[ARTRACE_EVENTS_PER_THREAD];
+};
+
+std::mutex gBuffersLock;
+std::vector<ThreadBuffer *> gBuffers;   // Buffers outlive their threads, so events survive thread exit.
+thread_local ThreadBuffer *tBuffer = nullptr;
+
+ThreadBuffer *threadBuffer() {
+  if (!tBuffer) {
+    ThreadBuffer *b = new ThreadBuffer();
+    b->depth = 0;
+    b->count = 0;
+    std::lock_guard<std::mutex> lock(gBuffersLock);
+    b->tid = (uint32_t)gBuffers.size();
+    gBuffers.push_back(b);
+    tBuffer = b;
+  }
+  return tBuffer;
+}
+
+inline uint64_t nowNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Calls f(tid, event) for every event still held in the buffers.
+template <typename F>
+void forEachEvent(F f) {
+  std::lock_guard<std::mutex> lock(gBuffersLock);
+  for (ThreadBuffer *b : gBuffers) {
+    const uint64_t count = b->count.load(std::memory_order_acquire);
+    const uint64_t first = (count > ARTRACE_EVENTS_PER_THREAD ? count - ARTRACE_EVENTS_PER_THREAD : 0);
+    for (uint64_t i = first; i < count; i++) {
+      f(b->tid, b->events[i % ARTRACE_EVENTS_PER_THREAD]);
+    }
+  }
+}
+
+} // namespace
+
+ARTraceScope::ARTraceScope(const char *name) :
+  m_name(name),
+  m_start(nowNs()) {
+  threadBuffer()->depth++;
+}
+
+ARTraceScope::~ARTraceScope() {
+  const uint64_t end = nowNs();
+  ThreadBuffer *b = threadBuffer();
+  b->depth--;
+  const uint64_t i = b->count.load(std::memory_order_relaxed);
+  b->events[i % ARTRACE_EVENTS_PER_THREAD] = {m_name, m_start, end, b->depth};
+  b->count.store(i + 1, std::memory_order_release);
+}
+
+void ARTraceClear(void) {
+  std::lock_guard<std::mutex> lock(gBuffersLock);
+  for (ThreadBuffer *b : gBuffers) {
+    b->count.store(0, std::memory_order_release);
+  }
+}
+
+bool ARTraceWriteChromeJSON(const char *path) {
+  FILE *fp = fopen(path, "w");
+  if (!fp) {
+    ARLOGe("Error opening trace file '%s'.\n", path);
+    return false;
+  }
+  uint64_t origin = UINT64_MAX;
+  forEachEvent([&](uint32_t, const Event &e) { origin = std::min(origin, e.start); });
+
+  fputs("{\"traceEvents\":[", fp);
+  bool first = true;
+  forEachEvent([&](uint32_t tid, const Event &e) {
+    fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            (first ? "" : ","), e.name, tid, (double)(e.start - origin) * 1e-3, (double)(e.end - e.start) * 1e-3);
+    first = false;
+  });
+  fputs("\n],\"displayTimeUnit\":\"ms\"}\n", fp);
+  return (fclose(fp) == 0);
+}
+
+void ARTracePrintStats(void) {
+  struct Stat {
+    uint32_t depth = 0;
+    const char *name = nullptr;
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint64_t max = 0;
+  };
+  // Events are stored in end order; sorting each thread's events by start time puts every
+  // parent before its children, so the path of a scope is its parent's path plus its name.
+  std::vector<std::vector<Event>> threads;
+  forEachEvent([&](uint32_t tid, const Event &e) {
+    if (tid >= threads.size()) threads.resize(tid + 1);
+    threads[tid].push_back(e);
+  });
+  std::map<std::string, Stat> stats;
+  for (std::vector<Event> &events : threads) {
+    std::sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+      return (a.start != b.start ? a.start < b.start : a.depth < b.depth);
+    });
+    std::vector<std::string> paths;
+    for (const Event &e : events) {
+      if (paths.size() < e.depth + 1) paths.resize(e.depth + 1);
+      paths[e.depth] = (e.depth > 0 ? paths[e.depth - 1] + "/" : std::string()) + e.name;
+      Stat &s = stats[paths[e.depth]];
+      const uint64_t d = e.end - e.start;
+      s.depth = e.depth;
+      s.name = e.name;
+      s.count++;
+      s.total += d;
+      s.max = std::max(s.max, d);
+    }
+  }
+  ARLOGi("%-40s %8s %12s %10s %10s\n", "scope", "count", "total (ms)", "mean (ms)", "max (ms)");
+  for (const auto &kv : stats) {
+    const Stat &s = kv.second;
+    const std::string label = std::string(s.depth * 2, ' ') + s.name;
+    ARLOGi("%-40s %8llu %12.3f %10.3f %10.3f\n", label.c_str(), (unsigned long long)s.count,
+           s.total * 1e-6, s.total * 1e-6 / s.count, s.max * 1e-6);
+  }
+}
+
+#else // !ARTRACE_ENABLED
+
+ARTraceScope::ARTraceScope(const char *name) :
+  m_name(name),
+  m_start(0) {
+}
+
+ARTraceScope::~ARTraceScope() {
+}
+
+void ARTraceClear(void) {
+}
+
+bool ARTraceWriteChromeJSON(const char *path) {
+  return false;
+}
+
+void ARTracePrintStats(void) {
+}
+
+#endif // ARTRACE_ENABLED